@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ConcurrentHashMap.hpp"
+
+
+// Baseline that every user of the library would otherwise write by hand
+class LockedUnorderedMap {
+public:
+    std::optional<uint64_t> get(uint64_t key) {
+        std::lock_guard<std::mutex> lk(mutex);
+        auto it = map.find(key);
+        return it == map.end() ? std::nullopt : std::optional<uint64_t>(it->second);
+    }
+
+    void put(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> lk(mutex);
+        map.insert_or_assign(key, value);
+    }
+
+private:
+    std::unordered_map<uint64_t, uint64_t> map;
+    std::mutex mutex;
+};
+
+static constexpr uint64_t NKEYS = 1 << 16;
+static constexpr uint64_t NOPS = 1 << 22;
+
+// Returns millions of operations per second across all threads for the given read percentage
+template<typename MapT>
+double run(MapT &map, unsigned nthreads, unsigned read_percent) {
+    for (uint64_t key = 0; key < NKEYS; key++) {
+        map.put(key, key);
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < nthreads; t++) {
+        threads.emplace_back([&map, t, nthreads, read_percent] {
+            std::mt19937_64 rng(t);
+            uint64_t sink = 0;
+            for (uint64_t i = 0; i < NOPS / nthreads; i++) {
+                uint64_t r = rng();
+                uint64_t key = r % NKEYS;
+                if ((r >> 32) % 100 < read_percent) {
+                    sink += map.get(key).value_or(0);
+                } else {
+                    map.put(key, i);
+                }
+            }
+            // Keep the reads from being optimized away
+            if (sink == 1) {
+                std::printf(" ");
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(NOPS) / elapsed.count() / 1e6;
+}
+
+int main() {
+    std::printf("%-10s %8s %22s %22s\n", "read/write", "threads", "ConcurrentHashMap Mops", "locked map Mops");
+    for (unsigned read_percent: {90u, 50u}) {
+        for (unsigned nthreads = 1; nthreads <= 64; nthreads *= 2) {
+            double concurrent_mops;
+            double locked_mops;
+            {
+                conc::ConcurrentHashMap<uint64_t, uint64_t> map(NKEYS, 64);
+                concurrent_mops = run(map, nthreads, read_percent);
+            }
+            {
+                LockedUnorderedMap map;
+                locked_mops = run(map, nthreads, read_percent);
+            }
+            std::printf("%7u/%-2u %8u %22.2f %22.2f\n",
+                        read_percent, 100 - read_percent, nthreads, concurrent_mops, locked_mops);
+        }
+    }
+    return 0;
+}
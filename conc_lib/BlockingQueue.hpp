@@ -78,8 +78,8 @@ namespace conc {
         LockWithHooks<std::mutex> lock_on_remove() override;
 
     private:
-        uint32_t consumers_waiting;
-        uint32_t producers_waiting;
+        uint32_t consumers_waiting = 0;
+        uint32_t producers_waiting = 0;
     };
 
     template<typename ElemT, uint32_t Size>
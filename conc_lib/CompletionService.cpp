@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <type_traits>
+#include "CompletionService.hpp"
+
+
+/*************************************************************************************************************
+ ****************************************** ExecutorCompletionService ****************************************
+ *************************************************************************************************************
+ */
+
+template<typename T>
+conc::ExecutorCompletionService<T>::ExecutorCompletionService(ThreadPool<> pool)
+        : pool(std::move(pool)), queue(std::make_shared<CompletionQueue_>()) {
+}
+
+template<typename T>
+void conc::ExecutorCompletionService<T>::submit(const std::function<T()> &job) {
+    // Every copy of the wrapper shares one PendingResult_, so a job the pool drops without running still completes
+    // once the pool lets go of it
+    pool->submit([pending = std::make_shared<PendingResult_>(queue, job)] -> void {
+        pending->run();
+    });
+}
+
+template<typename T>
+std::future<T> conc::ExecutorCompletionService<T>::take() {
+    std::unique_lock<std::mutex> lk(queue->completed_mutex);
+    if (queue->completed.empty()) {
+        // A pool thread left online would hold up reclamation everywhere until a result arrives
+        EpochOffline offline;
+        queue->not_empty_cv.wait(lk, [this] -> bool { return !queue->completed.empty(); });
+    }
+    std::future<T> result = std::move(queue->completed.front());
+    queue->completed.pop_front();
+    return result;
+}
+
+template<typename T>
+std::optional<std::future<T>> conc::ExecutorCompletionService<T>::poll(uint32_t timeout) {
+    std::unique_lock<std::mutex> lk(queue->completed_mutex);
+    if (queue->completed.empty()) {
+        if (timeout == 0) {
+            return std::nullopt;
+        }
+        EpochOffline offline;
+        if (!queue->not_empty_cv.wait_for(lk,
+                                          std::chrono::milliseconds(timeout),
+                                          [this] -> bool { return !queue->completed.empty(); })) {
+            return std::nullopt;
+        }
+    }
+    std::future<T> result = std::move(queue->completed.front());
+    queue->completed.pop_front();
+    return result;
+}
+
+template<typename T>
+std::optional<std::future<T>> conc::ExecutorCompletionService<T>::poll() {
+    return poll(0);
+}
+
+template<typename T>
+size_t conc::ExecutorCompletionService<T>::drain_to(std::vector<std::future<T>> &results, size_t max_elements) {
+    std::lock_guard<std::mutex> lk(queue->completed_mutex);
+    size_t ndrained = std::min(max_elements, queue->completed.size());
+    for (size_t i = 0; i < ndrained; ++i) {
+        results.emplace_back(std::move(queue->completed.front()));
+        queue->completed.pop_front();
+    }
+    return ndrained;
+}
+
+template<typename T>
+void conc::ExecutorCompletionService<T>::complete(CompletionQueue_ &queue, std::future<T> &&result) {
+    {
+        std::lock_guard<std::mutex> lk(queue.completed_mutex);
+        queue.completed.emplace_back(std::move(result));
+    }
+    queue.not_empty_cv.notify_one();
+}
+
+
+/**************************************************************************************************
+ ****************************************** PendingResult_ ****************************************
+ **************************************************************************************************
+ */
+
+template<typename T>
+conc::ExecutorCompletionService<T>::PendingResult_::PendingResult_(
+        const std::shared_ptr<CompletionQueue_> &queue,
+        const std::function<T()> &job) : queue(queue), job(job) {
+}
+
+template<typename T>
+void conc::ExecutorCompletionService<T>::PendingResult_::run() {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            job();
+            promise.set_value();
+        } else {
+            promise.set_value(job());
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    completed = true;
+    complete(*queue, promise.get_future());
+}
+
+template<typename T>
+conc::ExecutorCompletionService<T>::PendingResult_::~PendingResult_() {
+    if (!completed) {
+        promise.set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        complete(*queue, promise.get_future());
+    }
+}
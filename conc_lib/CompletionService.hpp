@@ -0,0 +1,77 @@
+#ifndef CONC_DEV_COMPLETIONSERVICE_HPP
+#define CONC_DEV_COMPLETIONSERVICE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "Reclamation.hpp"
+#include "ThreadPool.hpp"
+
+
+namespace conc {
+    // Runs jobs on a thread pool and hands back their results in the order the jobs complete, rather than the order
+    // they were submitted. Each result is a ready future, so a job that threw rethrows from get().
+    //
+    // Completed results outlive the service's handle on them, since jobs may still finish after it is destroyed.
+    template<typename T>
+    class ExecutorCompletionService {
+    public:
+        explicit ExecutorCompletionService(ThreadPool<> pool);
+
+        // Jobs that the pool drops without running, whether submitted after it started shutting down or discarded by
+        // shutdown_now(), complete with a std::future_error carrying std::future_errc::broken_promise
+        void submit(const std::function<T()> &job);
+
+        // Blocking calls take the calling thread offline while they wait, so they are safe to make from pool jobs
+        std::future<T> take();
+
+        std::optional<std::future<T>> poll(uint32_t timeout);
+
+        std::optional<std::future<T>> poll();
+
+        // Moves up to max_elements already completed results into results without blocking, and returns how many
+        // were moved. Consumes a whole batch under a single acquisition of the queue's lock.
+        size_t drain_to(std::vector<std::future<T>> &results, size_t max_elements);
+
+    private:
+        struct CompletionQueue_ {
+            std::deque<std::future<T>> completed;
+            std::mutex completed_mutex;
+            std::condition_variable not_empty_cv;
+        };
+
+        // Owned by every copy of a submitted job. Completes with broken_promise if the last copy is destroyed
+        // without the job having run.
+        struct PendingResult_ {
+            PendingResult_(const std::shared_ptr<CompletionQueue_> &queue, const std::function<T()> &job);
+
+            PendingResult_(const PendingResult_ &other) = delete;
+
+            PendingResult_ &operator=(const PendingResult_ &other) = delete;
+
+            ~PendingResult_();
+
+            void run();
+
+            const std::shared_ptr<CompletionQueue_> queue;
+            const std::function<T()> job;
+            std::promise<T> promise;
+            bool completed = false;
+        };
+
+        static void complete(CompletionQueue_ &queue, std::future<T> &&result);
+
+        ThreadPool<> pool;
+        std::shared_ptr<CompletionQueue_> queue;
+    };
+}
+
+#include "CompletionService.cpp"
+
+#endif //CONC_DEV_COMPLETIONSERVICE_HPP
@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <tuple>
+#include <thread>
+#include "ConcurrentHashMap.hpp"
+
+
+/*****************************************************************************************************
+ ****************************************** ConcurrentHashMap ****************************************
+ *****************************************************************************************************
+ */
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::ConcurrentHashMap(size_t initial_capacity, uint16_t concurrency_level)
+        : hasher(), key_equal(), nstripes(std::bit_ceil(std::max<size_t>(concurrency_level, 1))),
+          stripes(new Stripe_[nstripes]) {
+    // Keep the table at least as wide as the stripes so that every bin maps to exactly one stripe
+    size_t capacity = std::bit_ceil(std::max(initial_capacity + initial_capacity / 3 + 1, nstripes));
+    table.store(new Table_(capacity), std::memory_order_release);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::~ConcurrentHashMap() {
+    // A resize left unfinished by a failed transfer splits the entries between the current and the next table
+    Table_ *current = table.load(std::memory_order_acquire);
+    while (current != nullptr) {
+        for (size_t i = 0; i < current->capacity; ++i) {
+            Node_ *node = current->bins[i].load(std::memory_order_relaxed);
+            if (node == &current->moved) {
+                continue;
+            }
+            while (node != nullptr) {
+                Node_ *next = node->next.load(std::memory_order_relaxed);
+                delete static_cast<Entry_ *>(node);
+                node = next;
+            }
+        }
+        Table_ *next_table = current->next.load(std::memory_order_relaxed);
+        delete current;
+        current = next_table;
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::get(const K &key) const {
+    EpochGuard guard;
+    size_t hash = spread(key);
+    Table_ *current = table.load(std::memory_order_acquire);
+    while (true) {
+        Node_ *node = current->bins[hash & (current->capacity - 1)].load(std::memory_order_acquire);
+        if (node == &current->moved) {
+            current = current->next.load(std::memory_order_acquire);
+            continue;
+        }
+        for (; node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+            auto *entry = static_cast<Entry_ *>(node);
+            if (entry->hash == hash && key_equal(entry->key, key)) {
+                return entry->value;
+            }
+        }
+        return std::nullopt;
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::contains_key(const K &key) const {
+    return get(key).has_value();
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::put(const K &key, const V &value) {
+    EpochGuard guard;
+    size_t hash = spread(key);
+    std::optional<V> previous;
+    Table_ *current = with_bin_locked(hash, [&](std::atomic<Node_ *> &bin) -> void {
+        std::atomic<Node_ *> *link = find_link(bin, hash, key);
+        if (auto *entry = static_cast<Entry_ *>(link->load(std::memory_order_relaxed))) {
+            previous = entry->value;
+            replace_at(link, entry, value);
+        } else {
+            insert_at(link, hash, key, value);
+        }
+    });
+
+    if (!previous) {
+        on_insert(current, hash);
+    }
+    return previous;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::put_if_absent(const K &key, const V &value) {
+    EpochGuard guard;
+    // Skip the lock entirely when the key is already present
+    std::optional<V> existing = get(key);
+    if (existing) {
+        return existing;
+    }
+
+    size_t hash = spread(key);
+    Table_ *current = with_bin_locked(hash, [&](std::atomic<Node_ *> &bin) -> void {
+        std::atomic<Node_ *> *link = find_link(bin, hash, key);
+        if (auto *entry = static_cast<Entry_ *>(link->load(std::memory_order_relaxed))) {
+            existing = entry->value;
+        } else {
+            insert_at(link, hash, key, value);
+        }
+    });
+
+    if (!existing) {
+        on_insert(current, hash);
+    }
+    return existing;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::remove(const K &key) {
+    EpochGuard guard;
+    size_t hash = spread(key);
+    std::optional<V> previous;
+    with_bin_locked(hash, [&](std::atomic<Node_ *> &bin) -> void {
+        std::atomic<Node_ *> *link = find_link(bin, hash, key);
+        if (auto *entry = static_cast<Entry_ *>(link->load(std::memory_order_relaxed))) {
+            previous = entry->value;
+            erase_at(link, entry);
+        }
+    });
+    return previous;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+V conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::compute_if_absent(
+        const K &key,
+        const std::function<V(const K &)> &mapping_function) {
+    EpochGuard guard;
+    std::optional<V> result = get(key);
+    if (result) {
+        return *result;
+    }
+
+    size_t hash = spread(key);
+    bool inserted = false;
+    Table_ *current = with_bin_locked(hash, [&](std::atomic<Node_ *> &bin) -> void {
+        std::atomic<Node_ *> *link = find_link(bin, hash, key);
+        if (auto *entry = static_cast<Entry_ *>(link->load(std::memory_order_relaxed))) {
+            result = entry->value;
+        } else {
+            result = mapping_function(key);
+            insert_at(link, hash, key, *result);
+            inserted = true;
+        }
+    });
+
+    if (inserted) {
+        on_insert(current, hash);
+    }
+    return *result;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+V conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::merge(
+        const K &key,
+        const V &value,
+        const std::function<V(const V &, const V &)> &remapping_function) {
+    EpochGuard guard;
+    size_t hash = spread(key);
+    std::optional<V> result;
+    bool inserted = false;
+    Table_ *current = with_bin_locked(hash, [&](std::atomic<Node_ *> &bin) -> void {
+        std::atomic<Node_ *> *link = find_link(bin, hash, key);
+        if (auto *entry = static_cast<Entry_ *>(link->load(std::memory_order_relaxed))) {
+            result = remapping_function(entry->value, value);
+            replace_at(link, entry, *result);
+        } else {
+            result = value;
+            insert_at(link, hash, key, value);
+            inserted = true;
+        }
+    });
+
+    if (inserted) {
+        on_insert(current, hash);
+    }
+    return *result;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < nstripes; ++i) {
+        total += stripes[i].count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::is_empty() const {
+    return size() == 0;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+template<typename BinOpT>
+typename conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Table_ *
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::with_bin_locked(size_t hash, BinOpT &&op) {
+    Table_ *current = table.load(std::memory_order_acquire);
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lk(stripe_for(hash).mutex);
+            std::atomic<Node_ *> &bin = current->bins[hash & (current->capacity - 1)];
+            if (bin.load(std::memory_order_relaxed) != &current->moved) {
+                op(bin);
+                return current;
+            }
+        }
+        // The bin has already been transferred. Help finish the resize before retrying in the next table.
+        transfer(current);
+        current = current->next.load(std::memory_order_acquire);
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+std::atomic<typename conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Node_ *> *
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::find_link(std::atomic<Node_ *> &bin,
+                                                        size_t hash,
+                                                        const K &key) const {
+    std::atomic<Node_ *> *link = &bin;
+    for (Node_ *node; (node = link->load(std::memory_order_relaxed)) != nullptr; link = &node->next) {
+        if (node->hash == hash && key_equal(static_cast<Entry_ *>(node)->key, key)) {
+            break;
+        }
+    }
+    return link;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::insert_at(std::atomic<Node_ *> *link,
+                                                              size_t hash,
+                                                              const K &key,
+                                                              const V &value) {
+    link->store(new Entry_(hash, key, value, nullptr), std::memory_order_release);
+    stripe_for(hash).count.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::replace_at(std::atomic<Node_ *> *link,
+                                                               Entry_ *entry,
+                                                               const V &value) {
+    auto *replacement = new Entry_(entry->hash, entry->key, value, entry->next.load(std::memory_order_relaxed));
+    link->store(replacement, std::memory_order_release);
+    EpochGuard::retire(entry);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::erase_at(std::atomic<Node_ *> *link, Entry_ *entry) {
+    link->store(entry->next.load(std::memory_order_relaxed), std::memory_order_release);
+    EpochGuard::retire(entry);
+    stripe_for(entry->hash).count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::on_insert(Table_ *current, size_t hash) {
+    if (current->next.load(std::memory_order_acquire) != nullptr) {
+        transfer(current);
+        return;
+    }
+
+    // Only pay for summing every stripe once this stripe alone suggests that the table is over its load factor
+    size_t threshold = current->capacity - current->capacity / 4;
+    if (stripe_for(hash).count.load(std::memory_order_relaxed) * nstripes < threshold || size() < threshold) {
+        return;
+    }
+    if (table.load(std::memory_order_acquire) != current) {
+        return;
+    }
+
+    Table_ *next_table;
+    try {
+        next_table = new Table_(current->capacity << 1);
+    } catch (const std::bad_alloc &) {
+        // Leave the resize to a later insert
+        return;
+    }
+    Table_ *expected = nullptr;
+    if (!current->next.compare_exchange_strong(expected, next_table, std::memory_order_acq_rel)) {
+        // Another writer started the resize first
+        delete next_table;
+    }
+    transfer(current);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::transfer(Table_ *current) {
+    Table_ *next_table = current->next.load(std::memory_order_acquire);
+    size_t stride = std::max<size_t>(
+            current->capacity / (8 * std::max(std::thread::hardware_concurrency(), 1u)),
+            MIN_TRANSFER_STRIDE);
+
+    size_t lo;
+    size_t hi;
+    while (claim_chunk(current, stride, lo, hi)) {
+        size_t index = lo;
+        try {
+            for (; index < hi; ++index) {
+                transfer_bin(current, next_table, index);
+            }
+        } catch (...) {
+            // transfer_bin leaves the bin it failed on untouched, so the rest of the chunk can simply be retried
+            std::lock_guard<std::mutex> lk(current->abandoned_mutex);
+            current->abandoned.emplace_back(index, hi);
+            current->nabandoned.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (index > lo) {
+            complete_chunk(current, next_table, index - lo);
+        }
+        if (index < hi) {
+            // Stop helping for now rather than failing an operation that has nothing to do with the failed bin
+            return;
+        }
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::claim_chunk(Table_ *current,
+                                                                size_t stride,
+                                                                size_t &lo,
+                                                                size_t &hi) {
+    // Claim chunks of bins from the top of the table down until there are none left to claim
+    hi = current->transfer_index.load(std::memory_order_relaxed);
+    while (hi > 0) {
+        lo = hi > stride ? hi - stride : 0;
+        if (current->transfer_index.compare_exchange_weak(hi, lo, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    if (current->nabandoned.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(current->abandoned_mutex);
+    if (current->abandoned.empty()) {
+        return false;
+    }
+    std::tie(lo, hi) = current->abandoned.back();
+    current->abandoned.pop_back();
+    current->nabandoned.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::complete_chunk(Table_ *current,
+                                                                   Table_ *next_table,
+                                                                   size_t ntransferred) {
+    // Whoever transfers the last bin publishes the next table
+    if (current->bins_transferred.fetch_add(ntransferred, std::memory_order_acq_rel) + ntransferred
+        == current->capacity) {
+        table.store(next_table, std::memory_order_release);
+        try {
+            EpochGuard::retire(current);
+        } catch (...) {
+            // The next table is already published, so the old one leaks instead
+        }
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::transfer_bin(Table_ *current, Table_ *next_table, size_t index) {
+    std::lock_guard<std::mutex> lk(stripe_for(index).mutex);
+    std::atomic<Node_ *> &bin = current->bins[index];
+    Node_ *head = bin.load(std::memory_order_relaxed);
+
+    // Every entry either stays at index or moves up by the old capacity. The longest tail of the bin that all moves
+    // the same way is shared with the next table as is; the entries ahead of it are copied, since readers may still
+    // be walking them in this table.
+    Node_ *last_run = head;
+    bool last_run_high = false;
+    for (Node_ *node = head; node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+        bool high = (node->hash & current->capacity) != 0;
+        if (node == head || high != last_run_high) {
+            last_run = node;
+            last_run_high = high;
+        }
+    }
+
+    Node_ *low = last_run_high ? nullptr : last_run;
+    Node_ *high = last_run_high ? last_run : nullptr;
+    try {
+        for (Node_ *node = head; node != last_run; node = node->next.load(std::memory_order_relaxed)) {
+            auto *entry = static_cast<Entry_ *>(node);
+            if ((node->hash & current->capacity) != 0) {
+                high = new Entry_(entry->hash, entry->key, entry->value, high);
+            } else {
+                low = new Entry_(entry->hash, entry->key, entry->value, low);
+            }
+        }
+    } catch (...) {
+        // Nothing has been published yet, so the bin is left exactly as it was
+        for (Node_ *copies: {low, high}) {
+            while (copies != nullptr && copies != last_run) {
+                Node_ *next = copies->next.load(std::memory_order_relaxed);
+                delete static_cast<Entry_ *>(copies);
+                copies = next;
+            }
+        }
+        throw;
+    }
+
+    next_table->bins[index].store(low, std::memory_order_relaxed);
+    next_table->bins[index + current->capacity].store(high, std::memory_order_relaxed);
+    bin.store(&current->moved, std::memory_order_release);
+
+    // The originals can only be retired once nothing in a live bin links to them. The old chain is never modified,
+    // so it still leads from head to the shared tail.
+    try {
+        for (Node_ *node = head; node != last_run;) {
+            Node_ *next = node->next.load(std::memory_order_relaxed);
+            EpochGuard::retire(static_cast<Entry_ *>(node));
+            node = next;
+        }
+    } catch (...) {
+        // The bin has already moved, so failing to retire the rest must not undo it. They leak instead.
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+typename conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Stripe_ &
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::stripe_for(size_t hash) const {
+    return stripes[hash & (nstripes - 1)];
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::spread(const K &key) const {
+    // Mix the high bits into the low bits, since only the low bits select a bin
+    size_t hash = hasher(key);
+    return hash ^ (hash >> 16);
+}
+
+
+/****************************************************************************************************
+ ****************************************** Node_ / Entry_ ******************************************
+ ****************************************************************************************************
+ */
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Node_::Node_(size_t hash, Node_ *next) : hash(hash), next(next) {
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Entry_::Entry_(size_t hash, const K &key, const V &value, Node_ *next)
+        : Node_(hash, next), key(key), value(value) {
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+conc::ConcurrentHashMap<K, V, Hash, KeyEqual>::Table_::Table_(size_t capacity)
+        : capacity(capacity), bins(new std::atomic<Node_ *>[capacity]()), moved(0, nullptr), next(nullptr),
+          transfer_index(capacity), bins_transferred(0), nabandoned(0) {
+    abandoned.reserve(capacity / MIN_TRANSFER_STRIDE + 1);
+}
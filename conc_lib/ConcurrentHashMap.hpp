@@ -0,0 +1,142 @@
+#ifndef CONC_DEV_CONCURRENTHASHMAP_HPP
+#define CONC_DEV_CONCURRENTHASHMAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "Reclamation.hpp"
+
+
+namespace conc {
+    // Hash map modeled on Java's ConcurrentHashMap. Reads never lock: entries are immutable once published, so
+    // updating a mapping swaps in a new entry. Writes lock one of a fixed set of stripes, chosen so that a bin and
+    // the two bins it splits into on resize always share a stripe. Resizing is cooperative: the table is transferred
+    // in chunks by whichever writers run into it, and each transferred bin is marked so that readers and writers
+    // follow it into the next table.
+    //
+    // Every operation runs under an EpochGuard, and entries and tables replaced by writers are retired to it, since
+    // readers may still be traversing them.
+    template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class ConcurrentHashMap {
+    public:
+        explicit ConcurrentHashMap(size_t initial_capacity = 16, uint16_t concurrency_level = 16);
+
+        ConcurrentHashMap(const ConcurrentHashMap &other) = delete;
+
+        ConcurrentHashMap &operator=(const ConcurrentHashMap &other) = delete;
+
+        ~ConcurrentHashMap();
+
+        std::optional<V> get(const K &key) const;
+
+        bool contains_key(const K &key) const;
+
+        // Returns the value previously mapped to key, if any
+        std::optional<V> put(const K &key, const V &value);
+
+        // Returns the value already mapped to key, if any, in which case the map is left unchanged
+        std::optional<V> put_if_absent(const K &key, const V &value);
+
+        // Returns the value previously mapped to key, if any
+        std::optional<V> remove(const K &key);
+
+        // Atomically maps key to mapping_function(key) if key is absent, and returns the value mapped to key. The
+        // function is invoked at most once per call, while holding the key's stripe, so it must not touch this map.
+        V compute_if_absent(const K &key, const std::function<V(const K &)> &mapping_function);
+
+        // Atomically maps key to value if key is absent, or otherwise to remapping_function(current, value), and
+        // returns the value mapped to key. The same locking caveat as compute_if_absent applies.
+        V merge(const K &key, const V &value, const std::function<V(const V &, const V &)> &remapping_function);
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] bool is_empty() const;
+
+    private:
+        struct Node_ {
+            explicit Node_(size_t hash, Node_ *next);
+
+            const size_t hash;
+            std::atomic<Node_ *> next;
+        };
+
+        struct Entry_ : Node_ {
+            Entry_(size_t hash, const K &key, const V &value, Node_ *next);
+
+            const K key;
+            const V value;
+        };
+
+        struct Table_ {
+            explicit Table_(size_t capacity);
+
+            const size_t capacity;
+            std::unique_ptr<std::atomic<Node_ *>[]> bins;
+            // Placed in a bin once its entries have been transferred to next
+            Node_ moved;
+            std::atomic<Table_ *> next;
+            std::atomic<size_t> transfer_index;
+            std::atomic<size_t> bins_transferred;
+            // Ranges of bins handed back by a transfer that failed partway, left for the next writer to retry. Reserved
+            // up front for one range per chunk, so that handing a range back never allocates.
+            std::vector<std::pair<size_t, size_t>> abandoned;
+            std::atomic<size_t> nabandoned;
+            std::mutex abandoned_mutex;
+        };
+
+        struct alignas(64) Stripe_ {
+            std::mutex mutex;
+            std::atomic<size_t> count;
+        };
+
+        // Locks the stripe guarding the bin for hash in the current table and invokes op(bin) under that lock,
+        // following moved bins into the next table as needed. Returns the table op was applied to.
+        template<typename BinOpT>
+        Table_ *with_bin_locked(size_t hash, BinOpT &&op);
+
+        // Returns the link pointing at key's entry in bin, or at the end of the bin if key is absent
+        std::atomic<Node_ *> *find_link(std::atomic<Node_ *> &bin, size_t hash, const K &key) const;
+
+        void insert_at(std::atomic<Node_ *> *link, size_t hash, const K &key, const V &value);
+
+        void replace_at(std::atomic<Node_ *> *link, Entry_ *entry, const V &value);
+
+        void erase_at(std::atomic<Node_ *> *link, Entry_ *entry);
+
+        // Absorbs allocation and copy failures, since the insert it follows has already been committed
+        void on_insert(Table_ *table, size_t hash);
+
+        // Helps move the table's bins into the next table. A bin that cannot be copied is handed back rather than
+        // failing the caller, so this only throws if locking does.
+        void transfer(Table_ *table);
+
+        // Claims the next range of bins to transfer, preferring ones no writer has tried yet
+        bool claim_chunk(Table_ *table, size_t stride, size_t &lo, size_t &hi);
+
+        void complete_chunk(Table_ *table, Table_ *next_table, size_t ntransferred);
+
+        void transfer_bin(Table_ *table, Table_ *next_table, size_t index);
+
+        Stripe_ &stripe_for(size_t hash) const;
+
+        size_t spread(const K &key) const;
+
+        static constexpr size_t MIN_TRANSFER_STRIDE = 16;
+
+        const Hash hasher;
+        const KeyEqual key_equal;
+        const size_t nstripes;
+        std::unique_ptr<Stripe_[]> stripes;
+        std::atomic<Table_ *> table;
+    };
+}
+
+#include "ConcurrentHashMap.cpp"
+
+#endif //CONC_DEV_CONCURRENTHASHMAP_HPP
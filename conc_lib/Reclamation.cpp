@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "Reclamation.hpp"
+
+
+// Retired pointers are only reclaimed once at least this many have accumulated on a thread, so that the cost of
+// scanning every thread's record is spread across many retirements
+static constexpr size_t RETIRE_BATCH_SIZE = 64;
+
+static constexpr uint64_t QUIESCENT = 0;
+
+// Invokes the deleters only after the pointers have been removed from any list, since a deleter may retire more
+static void delete_all(std::vector<conc::Retired_> &to_delete) {
+    for (conc::Retired_ &retired: to_delete) {
+        retired.deleter(retired.ptr);
+    }
+    to_delete.clear();
+}
+
+
+/*******************************************************************************************************
+ ****************************************** HazardPointer ****************************************
+ *******************************************************************************************************
+ */
+
+static std::atomic<conc::HazardRecord_ *> hazard_records(nullptr);
+static std::atomic<size_t> hazard_record_count(0);
+
+// Pointers still protected when their retiring thread exited, adopted by the next thread to scan
+static std::mutex hazard_orphans_mutex;
+static std::vector<conc::Retired_> hazard_orphans;
+static std::atomic<bool> hazard_orphans_pending(false);
+
+static void hazard_scan(std::vector<conc::Retired_> &retired) {
+    // Order the caller's unlinking of every retired pointer before the loads of the hazard slots below. Without it,
+    // an unlink published with a release store could become visible after the scan has already missed a slot that
+    // protect() went on to validate against the old link.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (hazard_orphans_pending.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lk(hazard_orphans_mutex, std::try_to_lock);
+        if (lk.owns_lock() && !hazard_orphans.empty()) {
+            retired.insert(retired.end(), hazard_orphans.begin(), hazard_orphans.end());
+            hazard_orphans.clear();
+            hazard_orphans_pending.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<const void *> protected_ptrs;
+    for (conc::HazardRecord_ *record = hazard_records.load(std::memory_order_acquire);
+         record != nullptr;
+         record = record->next) {
+        if (const void *ptr = record->pointer.load(std::memory_order_seq_cst)) {
+            protected_ptrs.push_back(ptr);
+        }
+    }
+    std::sort(protected_ptrs.begin(), protected_ptrs.end());
+
+    auto unprotected = std::partition(retired.begin(), retired.end(), [&protected_ptrs](const conc::Retired_ &r) {
+        return std::binary_search(protected_ptrs.begin(), protected_ptrs.end(), r.ptr);
+    });
+    std::vector<conc::Retired_> to_delete(unprotected, retired.end());
+    retired.erase(unprotected, retired.end());
+    delete_all(to_delete);
+}
+
+struct HazardThreadState_ {
+    std::vector<conc::Retired_> retired;
+
+    ~HazardThreadState_() {
+        hazard_scan(retired);
+        if (!retired.empty()) {
+            std::lock_guard<std::mutex> lk(hazard_orphans_mutex);
+            hazard_orphans.insert(hazard_orphans.end(), retired.begin(), retired.end());
+            hazard_orphans_pending.store(true, std::memory_order_relaxed);
+        }
+    }
+};
+
+static thread_local HazardThreadState_ hazard_thread_state;
+
+conc::HazardPointer::HazardPointer() {
+    for (record = hazard_records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed)
+            && record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    record = new HazardRecord_{nullptr, true, hazard_records.load(std::memory_order_relaxed)};
+    while (!hazard_records.compare_exchange_weak(record->next, record, std::memory_order_release)) {}
+    hazard_record_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+conc::HazardPointer::~HazardPointer() {
+    record->pointer.store(nullptr, std::memory_order_release);
+    record->in_use.store(false, std::memory_order_release);
+}
+
+void conc::HazardPointer::reset() {
+    record->pointer.store(nullptr, std::memory_order_release);
+}
+
+void conc::HazardPointer::retire(void *ptr, void (*deleter)(void *)) {
+    std::vector<Retired_> &retired = hazard_thread_state.retired;
+    retired.push_back({ptr, deleter, 0});
+    if (retired.size() >= std::max(RETIRE_BATCH_SIZE, 2 * hazard_record_count.load(std::memory_order_relaxed))) {
+        hazard_scan(retired);
+    }
+}
+
+void conc::HazardPointer::reclaim() {
+    hazard_scan(hazard_thread_state.retired);
+}
+
+
+/****************************************************************************************************
+ ****************************************** EpochGuard ****************************************
+ ****************************************************************************************************
+ */
+
+static std::atomic<uint64_t> global_epoch(QUIESCENT + 1);
+static std::atomic<conc::EpochRecord_ *> epoch_records(nullptr);
+
+// Pointers not yet safe to delete when their retiring thread exited, adopted by the next thread to reclaim
+static std::mutex epoch_orphans_mutex;
+static std::vector<conc::Retired_> epoch_orphans;
+static std::atomic<bool> epoch_orphans_pending(false);
+
+// Advances the global epoch if every pinned thread has observed it, and returns the resulting epoch
+static uint64_t try_advance_epoch() {
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    for (conc::EpochRecord_ *record = epoch_records.load(std::memory_order_acquire);
+         record != nullptr;
+         record = record->next) {
+        uint64_t observed = record->epoch.load(std::memory_order_seq_cst);
+        if (observed != QUIESCENT && observed != epoch) {
+            return epoch;
+        }
+    }
+    global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    return global_epoch.load(std::memory_order_seq_cst);
+}
+
+// Deletes every pointer in retired that is safe as of epoch
+static void epoch_reclaim(std::vector<conc::Retired_> &retired, uint64_t epoch) {
+    if (epoch_orphans_pending.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lk(epoch_orphans_mutex, std::try_to_lock);
+        if (lk.owns_lock() && !epoch_orphans.empty()) {
+            retired.insert(retired.end(), epoch_orphans.begin(), epoch_orphans.end());
+            epoch_orphans.clear();
+            epoch_orphans_pending.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    auto safe = std::partition(retired.begin(), retired.end(), [epoch](const conc::Retired_ &r) {
+        return r.epoch + 2 > epoch;
+    });
+    std::vector<conc::Retired_> to_delete(safe, retired.end());
+    retired.erase(safe, retired.end());
+    delete_all(to_delete);
+}
+
+struct EpochThreadState_ {
+    conc::EpochRecord_ *record = nullptr;
+    uint32_t depth = 0;
+    bool online = false;
+    std::vector<conc::Retired_> retired;
+    // Doubles while retired pointers are held up by a pinned thread, so that a stalled epoch does not turn every
+    // retirement into a full pass over this thread's list
+    size_t reclaim_at = RETIRE_BATCH_SIZE;
+
+    conc::EpochRecord_ *get_record() {
+        if (record != nullptr) {
+            return record;
+        }
+        for (record = epoch_records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed)
+                && record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+
+        record = new conc::EpochRecord_{QUIESCENT, true, epoch_records.load(std::memory_order_relaxed)};
+        while (!epoch_records.compare_exchange_weak(record->next, record, std::memory_order_release)) {}
+        return record;
+    }
+
+    void pin() {
+        conc::EpochRecord_ *pinned = get_record();
+        pinned->epoch.store(global_epoch.load(std::memory_order_seq_cst), std::memory_order_relaxed);
+        // Order the pin before any load of the structure it protects
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void unpin() const {
+        record->epoch.store(QUIESCENT, std::memory_order_release);
+    }
+
+    // Pointers need two advances past the epoch they were retired in. A thread in a quiescent state holds no
+    // references, so an online thread re-pins to the epoch it just advanced to and tries a second time.
+    void reclaim() {
+        uint64_t epoch = try_advance_epoch();
+        if (depth == 0) {
+            if (online) {
+                record->epoch.store(epoch, std::memory_order_seq_cst);
+            }
+            epoch = try_advance_epoch();
+            if (online) {
+                record->epoch.store(epoch, std::memory_order_seq_cst);
+            }
+        }
+        epoch_reclaim(retired, epoch);
+        reclaim_at = std::max(RETIRE_BATCH_SIZE, 2 * retired.size());
+    }
+
+    ~EpochThreadState_() {
+        if (record != nullptr) {
+            unpin();
+        }
+        online = false;
+        depth = 0;
+        reclaim();
+        if (!retired.empty()) {
+            std::lock_guard<std::mutex> lk(epoch_orphans_mutex);
+            epoch_orphans.insert(epoch_orphans.end(), retired.begin(), retired.end());
+            epoch_orphans_pending.store(true, std::memory_order_relaxed);
+        }
+        if (record != nullptr) {
+            record->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local EpochThreadState_ epoch_thread_state;
+
+conc::EpochGuard::EpochGuard() {
+    if (epoch_thread_state.depth++ == 0 && !epoch_thread_state.online) {
+        epoch_thread_state.pin();
+    }
+}
+
+conc::EpochGuard::~EpochGuard() {
+    if (--epoch_thread_state.depth == 0 && !epoch_thread_state.online) {
+        epoch_thread_state.unpin();
+    }
+}
+
+void conc::EpochGuard::retire(void *ptr, void (*deleter)(void *)) {
+    // Order the unlinking of ptr before reading the epoch it is tagged with
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    EpochThreadState_ &state = epoch_thread_state;
+    state.retired.push_back({ptr, deleter, global_epoch.load(std::memory_order_seq_cst)});
+    // An online thread's own pin keeps it from getting far, so it leaves reclaiming to its next quiescent state
+    if (!state.online && state.retired.size() >= state.reclaim_at) {
+        state.reclaim();
+    }
+}
+
+void conc::EpochGuard::reclaim() {
+    epoch_thread_state.reclaim();
+}
+
+void conc::EpochGuard::quiescent_state() {
+    EpochThreadState_ &state = epoch_thread_state;
+    if (!state.online || state.depth > 0) {
+        return;
+    }
+    // Only the store of the latest epoch sits on the hot path. Reclaiming waits for a full batch of retired pointers.
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    if (state.record->epoch.load(std::memory_order_relaxed) != epoch) {
+        state.record->epoch.store(epoch, std::memory_order_seq_cst);
+    }
+    if (state.retired.size() >= state.reclaim_at) {
+        state.reclaim();
+    }
+}
+
+void conc::EpochGuard::thread_online() {
+    EpochThreadState_ &state = epoch_thread_state;
+    if (state.online) {
+        return;
+    }
+    state.online = true;
+    if (state.depth == 0) {
+        state.pin();
+    }
+}
+
+void conc::EpochGuard::thread_offline() {
+    EpochThreadState_ &state = epoch_thread_state;
+    if (!state.online) {
+        return;
+    }
+    state.online = false;
+    if (state.depth == 0) {
+        state.unpin();
+    }
+}
+
+
+/******************************************************************************************************
+ ****************************************** EpochOffline ****************************************
+ ******************************************************************************************************
+ */
+
+conc::EpochOffline::EpochOffline() : was_online(epoch_thread_state.online) {
+    EpochGuard::thread_offline();
+}
+
+conc::EpochOffline::~EpochOffline() {
+    if (was_online) {
+        EpochGuard::thread_online();
+    }
+}
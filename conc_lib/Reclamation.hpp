@@ -0,0 +1,148 @@
+#ifndef CONC_DEV_RECLAMATION_HPP
+#define CONC_DEV_RECLAMATION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace conc {
+    // A pointer handed off for deletion once no thread can still be reading it
+    struct Retired_ {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    // Slots are never freed. A slot released by one thread is reused by the next thread that needs one.
+    struct HazardRecord_ {
+        std::atomic<const void *> pointer;
+        std::atomic<bool> in_use;
+        HazardRecord_ *next;
+    };
+
+    struct alignas(64) EpochRecord_ {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> in_use;
+        EpochRecord_ *next;
+    };
+
+    // Protects a single pointer at a time. Retired pointers are batched per thread and only deleted by a scan that
+    // finds no hazard pointer still publishing them. Suited to structures whose readers hold onto a handful of nodes
+    // and cannot tolerate a stalled reader holding up reclamation of everything else.
+    class HazardPointer {
+    public:
+        HazardPointer();
+
+        HazardPointer(const HazardPointer &other) = delete;
+
+        HazardPointer &operator=(const HazardPointer &other) = delete;
+
+        ~HazardPointer();
+
+        // Returns the current value of source, which will not be deleted before this is reset or destroyed
+        template<typename T>
+        T *protect(const std::atomic<T *> &source);
+
+        void reset();
+
+        static void retire(void *ptr, void (*deleter)(void *));
+
+        template<typename T>
+        static void retire(T *ptr);
+
+        // Deletes every pointer retired by this thread that is no longer protected
+        static void reclaim();
+
+    private:
+        HazardRecord_ *record;
+    };
+
+    // Pins the calling thread to the global epoch for the lifetime of the guard. Pointers retired in an epoch are
+    // deleted once the global epoch has advanced twice past it, which is only possible after every thread pinned at
+    // the time has left its guard. Guards nest.
+    //
+    // Long-lived worker threads can instead go online and announce quiescent states between units of work, which
+    // makes guards on those threads free. Workers in FixedThreadPool_ and CachedThreadPool_ do this already.
+    //
+    // The catch is that an online thread stays pinned for the whole unit of work, guard or no guard. A job that blocks
+    // on a pool thread (sleeping, I/O, waiting on a future) stops the epoch from advancing for every thread in the
+    // process until it returns, and retired pointers pile up in the meantime. Such jobs should hold an EpochOffline
+    // across the blocking call. ExecutorCompletionService's blocking calls do so already.
+    class EpochGuard {
+    public:
+        EpochGuard();
+
+        EpochGuard(const EpochGuard &other) = delete;
+
+        EpochGuard &operator=(const EpochGuard &other) = delete;
+
+        ~EpochGuard();
+
+        static void retire(void *ptr, void (*deleter)(void *));
+
+        template<typename T>
+        static void retire(T *ptr);
+
+        // Tries to advance the global epoch, then deletes every pointer retired by this thread that is now safe
+        static void reclaim();
+
+        // Declares that the calling thread holds no references into any epoch-protected structure. Reclaims only once
+        // a batch of retired pointers has built up, so the common case is a single store.
+        static void quiescent_state();
+
+        static void thread_online();
+
+        // Must be called before an online thread blocks, so that it does not hold up reclamation while idle
+        static void thread_offline();
+    };
+
+    // Takes the calling thread offline for the lifetime of the scope, if it was online, and brings it back online
+    // afterwards. Wrap blocking calls made from pool jobs in one. Safe to hold while an EpochGuard is alive on the
+    // same thread, but does not help then, since the guard keeps the thread pinned regardless.
+    class EpochOffline {
+    public:
+        EpochOffline();
+
+        EpochOffline(const EpochOffline &other) = delete;
+
+        EpochOffline &operator=(const EpochOffline &other) = delete;
+
+        ~EpochOffline();
+
+    private:
+        bool was_online;
+    };
+}
+
+
+/*******************************************************************************************************
+ ****************************************** Templated members ****************************************
+ *******************************************************************************************************
+ */
+
+template<typename T>
+T *conc::HazardPointer::protect(const std::atomic<T *> &source) {
+    T *ptr = source.load(std::memory_order_relaxed);
+    while (true) {
+        // Publish first, then confirm that the pointer was not retired before the publication became visible
+        record->pointer.store(ptr, std::memory_order_seq_cst);
+        T *current = source.load(std::memory_order_seq_cst);
+        if (current == ptr) {
+            return ptr;
+        }
+        ptr = current;
+    }
+}
+
+template<typename T>
+void conc::HazardPointer::retire(T *ptr) {
+    retire(ptr, [](void *p) -> void { delete static_cast<T *>(p); });
+}
+
+template<typename T>
+void conc::EpochGuard::retire(T *ptr) {
+    retire(ptr, [](void *p) -> void { delete static_cast<T *>(p); });
+}
+
+#endif //CONC_DEV_RECLAMATION_HPP
@@ -61,14 +61,21 @@ void conc::FixedThreadPool_::shutdown(bool join) {
 }
 
 void conc::FixedThreadPool_::shutdown_now(bool join) {
+    std::queue<std::function<void()>> dropped_tasks;
     {
         std::unique_lock<std::mutex> lk(tasks_mutex);
         if (is_shutdown_) {
             return;
         }
         is_shutdown_ = true;
+        dropped_tasks.swap(task_queue);
     }
     runner_cv.notify_all();
+    // A safe shutdown waiting on the queue to drain would otherwise never be woken
+    safe_shutdown_cv.notify_all();
+    // Destroy tasks that will never run right away rather than with the pool, outside the lock since their
+    // destructors may run arbitrary code
+    dropped_tasks = {};
     for (std::thread &active_thread: threads) {
         if (join) {
             active_thread.join();
@@ -94,15 +101,22 @@ void conc::FixedThreadPool_::submit(const std::function<void()> &job) {
 }
 
 void conc::FixedThreadPool_::run_thread(ThreadPool<FixedThreadPool_> &pool) {
+    EpochGuard::thread_online();
     while (true) {
         bool should_start_safe_shutdown;
         std::function<void()> job;
         {
             std::unique_lock<std::mutex> lk(pool->tasks_mutex);
-            pool->runner_cv.wait(lk, [&pool] -> bool {
-                return !pool->task_queue.empty() || pool->is_shutdown_;
-            });
+            if (pool->task_queue.empty() && !pool->is_shutdown_) {
+                // Idle workers must not hold up reclamation
+                EpochGuard::thread_offline();
+                pool->runner_cv.wait(lk, [&pool] -> bool {
+                    return !pool->task_queue.empty() || pool->is_shutdown_;
+                });
+                EpochGuard::thread_online();
+            }
             if (pool->is_shutdown_) {
+                EpochGuard::thread_offline();
                 return;
             }
             job = std::move(pool->task_queue.front());
@@ -113,6 +127,7 @@ void conc::FixedThreadPool_::run_thread(ThreadPool<FixedThreadPool_> &pool) {
         try {
             job();
         } catch (...) {}
+        EpochGuard::quiescent_state();
 
         if (should_start_safe_shutdown) {
             pool->safe_shutdown_cv.notify_all();
@@ -174,13 +189,21 @@ void conc::CachedThreadPool_::submit(const std::function<void()> &job) {
 void conc::CachedThreadPool_::run_thread(ThreadPool<CachedThreadPool_> &pool,
                                          std::function<void()> &initial_job) {
     std::optional<std::function<void()>> job = std::move(initial_job);
+    EpochGuard::thread_online();
     while (true) {
         // job will actually always contain a value. See exit condition below.
         try {
             job.value_or([] {})();
         } catch (...) {}
+        EpochGuard::quiescent_state();
+
+        // Idle workers must not hold up reclamation
+        EpochGuard::thread_offline();
+        job = pool->job_queue.poll(pool->thread_idle_timeout);
+        EpochGuard::thread_online();
 
-        if ((job = pool->job_queue.poll(pool->thread_idle_timeout)) == std::nullopt) {
+        if (job == std::nullopt) {
+            EpochGuard::thread_offline();
             // Start new thread to safely erase this running thread, if appropriate. Immediately detach new thread.
             std::thread([pool, thread_to_erase = std::this_thread::get_id()] -> void {
                 std::lock_guard<std::mutex> lk(pool->shutdown_or_thread_mod_mutex);
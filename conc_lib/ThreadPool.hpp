@@ -9,6 +9,7 @@
 #include <semaphore>
 #include <thread>
 #include "BlockingQueue.hpp"
+#include "Reclamation.hpp"
 
 
 namespace conc {
@@ -24,12 +25,14 @@ namespace conc {
 
         virtual void shutdown_now(bool join) = 0;
 
+        // Jobs run on threads that are online for epoch-based reclamation (see EpochGuard). A job that blocks should
+        // do so inside an EpochOffline, or it holds up reclamation process-wide until it returns.
         virtual void submit(const std::function<void()> &job) = 0;
 
     protected:
-        bool is_safe_shutdown_started_;
-        bool is_shutdown_;
-        bool is_terminated_;
+        bool is_safe_shutdown_started_ = false;
+        bool is_shutdown_ = false;
+        bool is_terminated_ = false;
         std::list<std::thread> threads;
     };
 
@@ -0,0 +1,129 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CompletionService.hpp"
+#include "Reclamation.hpp"
+
+
+BOOST_AUTO_TEST_CASE(ExecutorCompletionService_returns_results_in_completion_order) {
+    std::promise<void> release_straggler;
+    std::shared_future<void> straggler_released = release_straggler.get_future().share();
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(2);
+    conc::ExecutorCompletionService<int> completion_service(thread_pool);
+
+    completion_service.submit([straggler_released] {
+        conc::EpochOffline offline;
+        straggler_released.wait();
+        return 1;
+    });
+    completion_service.submit([] { return 2; });
+
+    // The straggler must not hold up the result that has already finished
+    BOOST_CHECK_EQUAL(completion_service.take().get(), 2);
+    BOOST_CHECK(!completion_service.poll(10).has_value());
+
+    release_straggler.set_value();
+    BOOST_CHECK_EQUAL(completion_service.take().get(), 1);
+    thread_pool->shutdown(true);
+}
+
+BOOST_AUTO_TEST_CASE(ExecutorCompletionService_propagates_exceptions) {
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(1);
+    conc::ExecutorCompletionService<int> completion_service(thread_pool);
+
+    completion_service.submit([]() -> int { throw std::runtime_error("failed"); });
+    BOOST_CHECK_THROW(completion_service.take().get(), std::runtime_error);
+
+    thread_pool->shutdown(true);
+    completion_service.submit([] { return 1; });
+    BOOST_CHECK_THROW(completion_service.poll().value().get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_CASE(ExecutorCompletionService_completes_jobs_dropped_by_shutdown_now) {
+    std::promise<void> running;
+    std::promise<void> release_running;
+    std::shared_future<void> running_released = release_running.get_future().share();
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(1);
+    conc::ExecutorCompletionService<int> completion_service(thread_pool);
+
+    completion_service.submit([&running, running_released] {
+        running.set_value();
+        conc::EpochOffline offline;
+        running_released.wait();
+        return 1;
+    });
+    completion_service.submit([] { return 2; });
+    running.get_future().wait();
+
+    // shutdown_now joins the running job, so it can only be released from another thread. The dropped job completes
+    // first, which also shows that shutdown_now has been issued by the time the running one is released.
+    std::future<int> dropped;
+    std::thread releaser([&completion_service, &dropped, &release_running] {
+        dropped = completion_service.take();
+        release_running.set_value();
+    });
+    thread_pool->shutdown_now(true);
+    releaser.join();
+
+    try {
+        dropped.get();
+        BOOST_FAIL("dropped job returned a value");
+    } catch (const std::future_error &e) {
+        BOOST_CHECK(e.code() == std::future_errc::broken_promise);
+    }
+    // The running job still finishes
+    BOOST_CHECK_EQUAL(completion_service.take().get(), 1);
+    BOOST_CHECK(!completion_service.poll().has_value());
+}
+
+BOOST_AUTO_TEST_CASE(ExecutorCompletionService_drains_completed_results) {
+    int ntasks = 100;
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(4);
+    conc::ExecutorCompletionService<void> completion_service(thread_pool);
+
+    for (int i = 0; i < ntasks; i++) {
+        completion_service.submit([] {});
+    }
+    thread_pool->shutdown(true);
+
+    std::vector<std::future<void>> results;
+    BOOST_CHECK_EQUAL(completion_service.drain_to(results, ntasks - 1), ntasks - 1);
+    BOOST_CHECK_EQUAL(completion_service.drain_to(results, ntasks), 1);
+    BOOST_CHECK_EQUAL(results.size(), ntasks);
+}
+
+BOOST_AUTO_TEST_CASE(ExecutorCompletionService_take_releases_the_epoch_while_blocked) {
+    static std::atomic<int> ndeleted(0);
+    std::promise<void> taking;
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(1);
+    conc::ThreadPool<> waiting_pool = conc::make_fixed_thread_pool(1);
+    conc::ExecutorCompletionService<int> completion_service(thread_pool);
+
+    waiting_pool->submit([&taking, &completion_service] {
+        taking.set_value();
+        completion_service.take();
+    });
+    taking.get_future().wait();
+
+    // The job only goes offline once it is inside take(), so give it until the deadline to get there
+    conc::EpochGuard::retire(new int(42), [](void *ptr) -> void {
+        delete static_cast<int *>(ptr);
+        ndeleted.fetch_add(1);
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ndeleted.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        conc::EpochGuard::reclaim();
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_EQUAL(ndeleted.load(), 1);
+
+    completion_service.submit([] { return 1; });
+    waiting_pool->shutdown(true);
+    thread_pool->shutdown(true);
+}
@@ -0,0 +1,129 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ConcurrentHashMap.hpp"
+
+
+// Copying throws once the countdown reaches zero, unless it is negative
+static std::atomic<int> copies_until_throw(-1);
+
+struct ThrowingValue {
+    explicit ThrowingValue(int value) : value(value) {
+    }
+
+    ThrowingValue(const ThrowingValue &other) : value(other.value) {
+        if (copies_until_throw.load() >= 0 && copies_until_throw.fetch_sub(1) == 0) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+
+    int value;
+};
+
+BOOST_AUTO_TEST_CASE(ConcurrentHashMap_basic_operations) {
+    conc::ConcurrentHashMap<std::string, int> map;
+
+    BOOST_CHECK(map.is_empty());
+    BOOST_CHECK(!map.put("a", 1).has_value());
+    BOOST_CHECK_EQUAL(map.put("a", 2).value(), 1);
+    BOOST_CHECK_EQUAL(map.put_if_absent("a", 3).value(), 2);
+    BOOST_CHECK_EQUAL(map.get("a").value(), 2);
+    BOOST_CHECK_EQUAL(map.size(), 1);
+
+    BOOST_CHECK_EQUAL(map.remove("a").value(), 2);
+    BOOST_CHECK(!map.remove("a").has_value());
+    BOOST_CHECK(!map.contains_key("a"));
+    BOOST_CHECK(map.is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentHashMap_concurrent_puts_with_resize) {
+    int nthreads = 8;
+    int nkeys_per_thread = 10000;
+    std::atomic<int> nmissed(0);
+    conc::ConcurrentHashMap<int, int> map(4, 4);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([&map, &nmissed, t, nkeys_per_thread]() {
+            for (int i = 0; i < nkeys_per_thread; i++) {
+                int key = t * nkeys_per_thread + i;
+                map.put(key, key);
+                // Readers must keep finding earlier keys while the table is being transferred underneath them
+                if (map.get(t * nkeys_per_thread) != t * nkeys_per_thread) {
+                    nmissed.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(nmissed.load(), 0);
+    BOOST_CHECK_EQUAL(map.size(), nthreads * nkeys_per_thread);
+    for (int key = 0; key < nthreads * nkeys_per_thread; key++) {
+        BOOST_REQUIRE_EQUAL(map.get(key).value(), key);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentHashMap_compute_if_absent_and_merge_are_atomic) {
+    int nthreads = 8;
+    int nincrements = 10000;
+    std::atomic<int> ncomputed(0);
+    conc::ConcurrentHashMap<int, int> map;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([&map, &ncomputed, nincrements]() {
+            for (int i = 0; i < nincrements; i++) {
+                map.compute_if_absent(i % 64, [&ncomputed](const int &) {
+                    ncomputed.fetch_add(1);
+                    return 0;
+                });
+                map.merge(-1, 1, [](const int &current, const int &value) { return current + value; });
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(ncomputed.load(), 64);
+    BOOST_CHECK_EQUAL(map.get(-1).value(), nthreads * nincrements);
+    BOOST_CHECK_EQUAL(map.size(), 65);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentHashMap_transfer_survives_throwing_copies) {
+    conc::ConcurrentHashMap<int, ThrowingValue> map(4, 1);
+
+    // Chain every key into a single bin, alternating between the two bins it splits into, so that the resize on the
+    // sixth insert has to copy entries
+    for (int key = 0; key < 40; key += 8) {
+        map.put(key, ThrowingValue(key));
+    }
+    // The insert's own copy succeeds, then the transfer fails on its second copy. The insert has already been made
+    // by then, so the failure must not reach the caller.
+    copies_until_throw.store(2);
+    BOOST_CHECK_NO_THROW(map.put(40, ThrowingValue(40)));
+    copies_until_throw.store(-1);
+
+    conc::EpochGuard::reclaim();
+    conc::EpochGuard::reclaim();
+    for (int key = 0; key <= 40; key += 8) {
+        BOOST_CHECK_EQUAL(map.get(key).value().value, key);
+    }
+
+    // The next writer retries the bin the failed transfer handed back and finishes the resize
+    for (int key = 1; key < 8; key++) {
+        map.put(key, ThrowingValue(key));
+    }
+    for (int key = 0; key <= 40; key += 8) {
+        BOOST_CHECK_EQUAL(map.get(key).value().value, key);
+    }
+    BOOST_CHECK_EQUAL(map.size(), 13);
+}
@@ -0,0 +1,105 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <future>
+#include <boost/test/unit_test.hpp>
+#include "Reclamation.hpp"
+#include "ThreadPool.hpp"
+
+
+static std::atomic<int> ndeleted(0);
+
+static void count_deletion(void *ptr) {
+    delete static_cast<int *>(ptr);
+    ndeleted.fetch_add(1);
+}
+
+BOOST_AUTO_TEST_CASE(HazardPointer_defers_deletion_while_protected) {
+    ndeleted.store(0);
+    std::atomic<int *> shared(new int(42));
+    conc::HazardPointer hazard;
+
+    int *protected_ptr = hazard.protect(shared);
+    shared.store(nullptr);
+    conc::HazardPointer::retire(protected_ptr, count_deletion);
+    conc::HazardPointer::reclaim();
+    BOOST_CHECK_EQUAL(ndeleted.load(), 0);
+    BOOST_CHECK_EQUAL(*protected_ptr, 42);
+
+    hazard.reset();
+    conc::HazardPointer::reclaim();
+    BOOST_CHECK_EQUAL(ndeleted.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(EpochGuard_defers_deletion_while_pinned) {
+    ndeleted.store(0);
+    std::atomic<bool> pinned(false);
+    std::atomic<bool> release(false);
+
+    // A reader on another thread pins the epoch in which the pointer is retired
+    std::thread reader([&pinned, &release] {
+        conc::EpochGuard guard;
+        pinned.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned.load()) {
+        std::this_thread::yield();
+    }
+
+    conc::EpochGuard::retire(new int(42), count_deletion);
+    conc::EpochGuard::reclaim();
+    conc::EpochGuard::reclaim();
+    BOOST_CHECK_EQUAL(ndeleted.load(), 0);
+
+    release.store(true);
+    reader.join();
+    conc::EpochGuard::reclaim();
+    conc::EpochGuard::reclaim();
+    BOOST_CHECK_EQUAL(ndeleted.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FixedThreadPool_announces_quiescent_states) {
+    ndeleted.store(0);
+    std::promise<int> deleted_before_shutdown;
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(1);
+
+    // A single trickle of retirements waits for more, but the quiescent state after a full batch reclaims all of it,
+    // without the job ever reclaiming explicitly
+    thread_pool->submit([] { conc::EpochGuard::retire(new int(42), count_deletion); });
+    thread_pool->submit([&deleted_before_shutdown] { deleted_before_shutdown.set_value(ndeleted.load()); });
+    BOOST_CHECK_EQUAL(deleted_before_shutdown.get_future().get(), 0);
+
+    std::promise<int> deleted_after_batch;
+    thread_pool->submit([] {
+        for (int i = 1; i < 64; i++) {
+            conc::EpochGuard::retire(new int(42), count_deletion);
+        }
+    });
+    thread_pool->submit([&deleted_after_batch] { deleted_after_batch.set_value(ndeleted.load()); });
+    BOOST_CHECK_EQUAL(deleted_after_batch.get_future().get(), 64);
+    thread_pool->shutdown(true);
+}
+
+BOOST_AUTO_TEST_CASE(EpochOffline_lets_blocked_jobs_release_the_epoch) {
+    ndeleted.store(0);
+    std::promise<void> blocked;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    conc::ThreadPool<> thread_pool = conc::make_fixed_thread_pool(1);
+
+    thread_pool->submit([&blocked, released] {
+        conc::EpochOffline offline;
+        blocked.set_value();
+        released.wait();
+    });
+    blocked.get_future().wait();
+
+    conc::EpochGuard::retire(new int(42), count_deletion);
+    conc::EpochGuard::reclaim();
+    BOOST_CHECK_EQUAL(ndeleted.load(), 1);
+
+    release.set_value();
+    thread_pool->shutdown(true);
+}